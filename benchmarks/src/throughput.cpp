@@ -0,0 +1,194 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "scran_tests/simulate_vector.hpp"
+#include "scran_tests/simulate_compressed_sparse_matrix.hpp"
+#include "scran_tests/compare_almost_equal.hpp"
+
+/*
+ * Throughput benchmarks for the simulators and comparators in scran_tests.
+ *
+ * Results are written as tab-separated values with a fixed header, one row per configuration.
+ * The first line is a format marker that should be bumped whenever the columns change,
+ * so that downstream tracking can refuse to compare incompatible result files.
+ *
+ * Usage: throughput [--output FILE] [--min-time SECONDS]
+ */
+
+namespace {
+
+// Written to prevent the compiler from optimizing away the benchmarked calls.
+volatile double sink = 0;
+
+struct Timing {
+    std::size_t iterations;
+    double seconds_per_call;
+};
+
+template<class Function_>
+Timing time_calls(Function_ fun, double min_time) {
+    typedef std::chrono::steady_clock Clock;
+
+    // Warm-up call to fault in the allocator and caches.
+    fun();
+
+    std::size_t iterations = 0;
+    const auto start = Clock::now();
+    double elapsed = 0;
+    do {
+        fun();
+        ++iterations;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    } while (elapsed < min_time);
+
+    return Timing{ iterations, elapsed / iterations };
+}
+
+template<typename Type_>
+const char* type_name() {
+    if constexpr(std::is_same<Type_, double>::value) {
+        return "double";
+    } else if constexpr(std::is_same<Type_, float>::value) {
+        return "float";
+    } else if constexpr(std::is_same<Type_, std::int32_t>::value) {
+        return "int32";
+    } else if constexpr(std::is_same<Type_, std::uint16_t>::value) {
+        return "uint16";
+    } else {
+        static_assert(std::is_same<Type_, std::uint8_t>::value, "unknown type for the benchmark output");
+        return "uint8";
+    }
+}
+
+void report(std::ostream& out, const char* function, const char* type, const std::string& size, double density, const Timing& timing, double elements, double nonzeros) {
+    out << function << '\t'
+        << type << '\t'
+        << size << '\t'
+        << density << '\t'
+        << timing.iterations << '\t'
+        << timing.seconds_per_call << '\t'
+        << elements / timing.seconds_per_call << '\t'
+        << nonzeros / timing.seconds_per_call << '\n';
+}
+
+template<typename Type_>
+void benchmark_simulate_vector(std::ostream& out, const std::vector<std::size_t>& sizes, const std::vector<double>& densities, double min_time) {
+    for (auto n : sizes) {
+        for (auto d : densities) {
+            scran_tests::SimulateVectorParameters<Type_> params;
+            params.density = d;
+
+            auto timing = time_calls([&]() -> void {
+                auto res = scran_tests::simulate_vector<Type_>(n, params);
+                sink = sink + res.back();
+            }, min_time);
+
+            // Counting outside of the timed calls, as the output is the same for every call.
+            std::size_t nnz = 0;
+            for (auto x : scran_tests::simulate_vector<Type_>(n, params)) {
+                nnz += (x != 0);
+            }
+
+            report(out, "simulate_vector", type_name<Type_>(), std::to_string(n), d, timing, n, nnz);
+        }
+    }
+}
+
+template<typename Data_, typename Index_>
+void benchmark_simulate_compressed_sparse_matrix(std::ostream& out, const std::vector<std::pair<Index_, Index_> >& dims, const std::vector<double>& densities, double min_time) {
+    for (const auto& dim : dims) {
+        for (auto d : densities) {
+            scran_tests::SimulateCompressedSparseMatrixParameters<Data_> params;
+            params.density = d;
+
+            std::size_t nnz = 0;
+            auto timing = time_calls([&]() -> void {
+                auto res = scran_tests::simulate_compressed_sparse_matrix<Data_, Index_>(dim.first, dim.second, params);
+                nnz = res.pointers.back();
+                sink = sink + nnz;
+            }, min_time);
+
+            const double elements = static_cast<double>(dim.first) * static_cast<double>(dim.second);
+            report(out, "simulate_compressed_sparse_matrix", type_name<Data_>(), std::to_string(dim.first) + "x" + std::to_string(dim.second), d, timing, elements, nnz);
+        }
+    }
+}
+
+template<typename Type_>
+void benchmark_compare_almost_equal_containers(std::ostream& out, const std::vector<std::size_t>& sizes, double min_time) {
+    for (auto n : sizes) {
+        auto left = scran_tests::simulate_vector<Type_>(n, scran_tests::SimulateVectorParameters<Type_>());
+        auto right = left;
+
+        // Perturbing the values so that we don't just hit the exact equality shortcut.
+        // This needs to be large enough to survive rounding for floats, hence the looser tolerance.
+        for (auto& r : right) {
+            r *= static_cast<Type_>(1 + 1e-7);
+        }
+        scran_tests::CompareAlmostEqualParameters params;
+        params.relative_tolerance = 1e-6;
+
+        auto timing = time_calls([&]() -> void {
+            scran_tests::compare_almost_equal_containers(left, right, params);
+            sink = sink + right.back();
+        }, min_time);
+
+        report(out, "compare_almost_equal_containers", type_name<Type_>(), std::to_string(n), 1, timing, n, n);
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string output;
+    double min_time = 0.2;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg(argv[i]);
+        if (arg == "--output" && i + 1 < argc) {
+            output = argv[++i];
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            min_time = std::stod(argv[++i]);
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--output FILE] [--min-time SECONDS]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::ofstream file;
+    if (!output.empty()) {
+        file.open(output);
+        if (!file) {
+            std::cerr << "failed to open '" << output << "' for writing" << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = (output.empty() ? std::cout : file);
+
+    out << "# scran_tests throughput v1\n";
+    out << "function\ttype\tsize\tdensity\titerations\tseconds_per_call\telements_per_second\tnonzeros_per_second\n";
+
+    const std::vector<std::size_t> sizes{ 1000, 100000, 1000000 };
+    const std::vector<double> densities{ 0.01, 0.1, 0.5, 1 };
+
+    benchmark_simulate_vector<double>(out, sizes, densities, min_time);
+    benchmark_simulate_vector<std::int32_t>(out, sizes, densities, min_time);
+    benchmark_simulate_vector<std::uint8_t>(out, sizes, densities, min_time);
+
+    const std::vector<std::pair<int, int> > dims{ { 100, 200 }, { 1000, 1000 }, { 1000, 10000 } };
+    const std::vector<double> sparse_densities{ 0.01, 0.1, 0.5 };
+    benchmark_simulate_compressed_sparse_matrix<double, int>(out, dims, sparse_densities, min_time);
+    benchmark_simulate_compressed_sparse_matrix<std::uint16_t, int>(out, dims, sparse_densities, min_time);
+
+    benchmark_compare_almost_equal_containers<double>(out, sizes, min_time);
+    benchmark_compare_almost_equal_containers<float>(out, sizes, min_time);
+
+    return 0;
+}
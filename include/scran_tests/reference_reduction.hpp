@@ -0,0 +1,426 @@
+#ifndef SCRAN_TESTS_REFERENCE_REDUCTION_HPP
+#define SCRAN_TESTS_REFERENCE_REDUCTION_HPP
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+
+#include "simulate_compressed_sparse_matrix.hpp"
+
+/**
+ * @file reference_reduction.hpp
+ * @brief High-precision reference reductions with provable error bounds.
+ */
+
+namespace scran_tests {
+
+/**
+ * @brief Result of a reference reduction.
+ *
+ * Given the exact result of a reduction in real arithmetic, `value` is within `error` of the exact result,
+ * while any double-precision implementation of the standard algorithm is guaranteed to be within `tolerance` of the exact result.
+ * The standard algorithm is allowed to accumulate its terms in any order, so this covers reordered and vectorized implementations;
+ * see the documentation for each reduction for details.
+ */
+struct ReferenceResult {
+    /**
+     * Reference value of the reduction, computed with double-double accumulation.
+     */
+    double value;
+
+    /**
+     * Upper bound on the absolute difference between `value` and the exact result.
+     */
+    double error;
+
+    /**
+     * Upper bound on the absolute difference between the exact result and a double-precision result from the standard algorithm.
+     */
+    double tolerance;
+};
+
+/**
+ * @cond
+ */
+namespace reference_internal {
+
+constexpr double unit_roundoff = std::numeric_limits<double>::epsilon() / 2;
+
+// The usual gamma_k = k * u / (1 - k * u) from Higham's "Accuracy and Stability of Numerical Algorithms".
+inline double gamma(double k) {
+    if (k <= 0) {
+        return 0;
+    }
+    const double ku = k * unit_roundoff;
+    if (ku >= 1) {
+        return std::numeric_limits<double>::infinity();
+    }
+    return ku / (1 - ku);
+}
+
+inline void two_sum(double a, double b, double& sum, double& err) {
+    sum = a + b;
+    const double z = sum - a;
+    err = (a - (sum - z)) + (b - z);
+}
+
+inline void two_product(double a, double b, double& prod, double& err) {
+    prod = a * b;
+    err = std::fma(a, b, -prod);
+}
+
+// Compensated summation, i.e., 'Sum2' from Ogita, Rump and Oishi (2005), "Accurate sum and dot product".
+// The result is within 'u * |s| + gamma_{n-1}^2 * sum|x|' of the exact sum 's' of 'n' terms.
+struct DoubleDouble {
+    double hi = 0;
+    double lo = 0;
+    double magnitude = 0;
+    double count = 0;
+
+    void add(double x) {
+        double err;
+        two_sum(hi, x, hi, err);
+        lo += err;
+        magnitude += std::abs(x);
+        ++count;
+    }
+
+    double value() const {
+        return hi + lo;
+    }
+
+    double error() const {
+        // The computed 'magnitude' is itself subject to rounding, so we inflate it to be safe.
+        const double g = gamma(count);
+        const double upper_magnitude = magnitude * (1 + g);
+        return (unit_roundoff * std::abs(value()) + g * g * upper_magnitude) / (1 - unit_roundoff);
+    }
+};
+
+template<class Container_>
+ReferenceResult sum(const Container_& x, std::size_t start, std::size_t end, std::size_t num_zeros) {
+    DoubleDouble acc;
+    for (std::size_t i = start; i < end; ++i) {
+        acc.add(x[i]);
+    }
+
+    const double n = static_cast<double>(end - start + num_zeros);
+    const double g = gamma(n);
+    return ReferenceResult{ acc.value(), acc.error(), gamma(n - 1) * acc.magnitude * (1 + g) };
+}
+
+template<class Container_>
+ReferenceResult mean(const Container_& x, std::size_t start, std::size_t end, std::size_t num_zeros) {
+    const std::size_t n = end - start + num_zeros;
+    if (n == 0) {
+        return ReferenceResult{ std::numeric_limits<double>::quiet_NaN(), 0, 0 };
+    }
+
+    DoubleDouble acc;
+    for (std::size_t i = start; i < end; ++i) {
+        acc.add(x[i]);
+    }
+
+    // The division contributes another rounding error, for both the reference and the standard algorithm.
+    const double dn = static_cast<double>(n);
+    const double value = acc.value() / dn;
+    const double error = (acc.error() / dn + unit_roundoff * std::abs(value)) * (1 + 2 * unit_roundoff);
+    const double tolerance = gamma(dn) * acc.magnitude * (1 + gamma(dn)) / dn;
+    return ReferenceResult{ value, error, tolerance };
+}
+
+template<class Container_>
+ReferenceResult variance(const Container_& x, std::size_t start, std::size_t end, std::size_t num_zeros) {
+    const std::size_t n = end - start + num_zeros;
+    if (n < 2) {
+        return ReferenceResult{ std::numeric_limits<double>::quiet_NaN(), 0, 0 };
+    }
+
+    const auto m = mean(x, start, end, num_zeros);
+    const double center = m.value;
+
+    // Each 'x - center' is exactly representable as 'dh + dl', so we only lose precision from '2 * dh * dl' and 'dl * dl'.
+    // Those terms are at least a factor of 'u' smaller than 'dh * dh', so their rounding errors are negligible but we include them anyway.
+    DoubleDouble acc;
+    double residual_error = 0;
+    auto add_squared = [&](double val, double multiple) -> void {
+        double dh, dl;
+        two_sum(val, -center, dh, dl);
+
+        double sq, sq_err;
+        two_product(dh, dh, sq, sq_err);
+        const double cross = 2 * dh * dl + dl * dl;
+        if (multiple == 1) {
+            acc.add(sq);
+            acc.add(sq_err);
+            acc.add(cross);
+            residual_error += 3 * unit_roundoff * std::abs(cross);
+        } else {
+            double p, p_err;
+            two_product(sq, multiple, p, p_err);
+            acc.add(p);
+            acc.add(p_err);
+            const double rest = (sq_err + cross) * multiple;
+            acc.add(rest);
+            residual_error += 5 * unit_roundoff * std::abs(rest);
+        }
+    };
+
+    for (std::size_t i = start; i < end; ++i) {
+        add_squared(x[i], 1);
+    }
+    if (num_zeros) {
+        add_squared(0, static_cast<double>(num_zeros));
+    }
+
+    // The sum of squares around 'center' exceeds the sum of squares around the exact mean by 'n * (center - mean)^2'.
+    const double dn = static_cast<double>(n);
+    const double ss = acc.value();
+    const double ss_error = acc.error() + residual_error * (1 + gamma(acc.count)) + dn * m.error * m.error;
+    const double value = ss / (dn - 1);
+    const double error = (ss_error / (dn - 1) + unit_roundoff * std::abs(value)) * (1 + 2 * unit_roundoff);
+
+    // For the standard two-pass algorithm, the computed mean has error 'delta' (from the mean's tolerance).
+    // Centering on the computed mean adds 'n * delta^2' to the sum of squares, while the subtraction, squaring,
+    // summation in any order and final division are covered by gamma_{n+4}.
+    const double delta = m.tolerance;
+    const double ss_upper = ss + ss_error + dn * delta * delta;
+    const double tolerance = (dn * delta * delta + gamma(dn + 4) * ss_upper) / (dn - 1);
+    return ReferenceResult{ value, error, tolerance };
+}
+
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Compute a reference sum of a vector.
+ * The tolerance is the bound for recursive summation in double precision with any ordering, including pairwise and vectorized summation.
+ *
+ * @tparam Container_ Vector-like container of numeric values.
+ * @param x Vector of values.
+ * @return Reference sum of `x`.
+ */
+template<class Container_>
+ReferenceResult reference_sum(const Container_& x) {
+    return reference_internal::sum(x, 0, x.size(), 0);
+}
+
+/**
+ * Compute a reference mean of a vector.
+ * The tolerance is the bound for any double-precision summation followed by division by the length of `x`.
+ * If `x` is empty, the value is NaN.
+ *
+ * @tparam Container_ Vector-like container of numeric values.
+ * @param x Vector of values.
+ * @return Reference mean of `x`.
+ */
+template<class Container_>
+ReferenceResult reference_mean(const Container_& x) {
+    return reference_internal::mean(x, 0, x.size(), 0);
+}
+
+/**
+ * Compute a reference sample variance of a vector, i.e., with a denominator of \f$n - 1\f$.
+ * The tolerance is the bound for the two-pass algorithm in double precision, where the mean is computed first and the squared deviations from the mean are then summed, each in any order.
+ * Note that the textbook one-pass algorithm (sum of squares minus squared sum) is not covered by this bound and may be rejected.
+ * If `x` has fewer than two elements, the value is NaN.
+ *
+ * @tparam Container_ Vector-like container of numeric values.
+ * @param x Vector of values.
+ * @return Reference variance of `x`.
+ */
+template<class Container_>
+ReferenceResult reference_variance(const Container_& x) {
+    return reference_internal::variance(x, 0, x.size(), 0);
+}
+
+/**
+ * Compute a reference dot product of two vectors, using the 'Dot2' algorithm from Ogita, Rump and Oishi (2005).
+ * The tolerance is the bound for a double-precision dot product with any summation order.
+ *
+ * @tparam LeftContainer_ Vector-like container of numeric values.
+ * @tparam RightContainer_ Another vector-like container of numeric values.
+ * @param x Vector of values.
+ * @param y Another vector of values, of the same length as `x`.
+ * An error is raised if the lengths differ.
+ * @return Reference dot product of `x` and `y`.
+ */
+template<class LeftContainer_, class RightContainer_>
+ReferenceResult reference_dot(const LeftContainer_& x, const RightContainer_& y) {
+    const std::size_t n = x.size();
+    if (n != static_cast<std::size_t>(y.size())) {
+        throw std::runtime_error("vectors should have the same length");
+    }
+
+    reference_internal::DoubleDouble acc;
+    for (std::size_t i = 0; i < n; ++i) {
+        double p, p_err;
+        reference_internal::two_product(x[i], y[i], p, p_err);
+        acc.add(p);
+        acc.lo += p_err;
+    }
+
+    // Bound from Proposition 5.5 of Ogita, Rump and Oishi (2005).
+    const double dn = static_cast<double>(n);
+    const double g = reference_internal::gamma(dn);
+    const double magnitude = acc.magnitude * (1 + g) * (1 + reference_internal::unit_roundoff);
+    const double value = acc.value();
+    const double error = (reference_internal::unit_roundoff * std::abs(value) + g * g * magnitude) / (1 - reference_internal::unit_roundoff);
+    return ReferenceResult{ value, error, g * magnitude };
+}
+
+/**
+ * Compute reference sums for each primary dimension element of a compressed sparse matrix, e.g., the row sums of a compressed sparse row matrix.
+ * Each tolerance is computed as described for `reference_sum()`, treating the structural zeros as part of the vector.
+ *
+ * @tparam Data_ Numeric type of the data.
+ * @tparam Index_ Integer type of the indices.
+ * @tparam Pointer_ Integer type of the compressed sparse pointers.
+ *
+ * @param matrix Contents of a compressed sparse matrix, typically from `simulate_compressed_sparse_matrix()`.
+ * @return Vector of reference sums, one per primary dimension element.
+ */
+template<typename Data_, typename Index_, typename Pointer_>
+std::vector<ReferenceResult> reference_sparse_sums(const SimulatedCompressedSparseMatrix<Data_, Index_, Pointer_>& matrix) {
+    std::vector<ReferenceResult> output;
+    output.reserve(matrix.primary);
+    for (Index_ p = 0; p < matrix.primary; ++p) {
+        const std::size_t start = matrix.pointers[p], end = matrix.pointers[p + 1];
+        output.push_back(reference_internal::sum(matrix.data, start, end, static_cast<std::size_t>(matrix.secondary) - (end - start)));
+    }
+    return output;
+}
+
+/**
+ * Compute reference means for each primary dimension element of a compressed sparse matrix.
+ * Each mean is computed as described for `reference_mean()`, including the structural zeros.
+ *
+ * @tparam Data_ Numeric type of the data.
+ * @tparam Index_ Integer type of the indices.
+ * @tparam Pointer_ Integer type of the compressed sparse pointers.
+ *
+ * @param matrix Contents of a compressed sparse matrix.
+ * @return Vector of reference means, one per primary dimension element.
+ */
+template<typename Data_, typename Index_, typename Pointer_>
+std::vector<ReferenceResult> reference_sparse_means(const SimulatedCompressedSparseMatrix<Data_, Index_, Pointer_>& matrix) {
+    std::vector<ReferenceResult> output;
+    output.reserve(matrix.primary);
+    for (Index_ p = 0; p < matrix.primary; ++p) {
+        const std::size_t start = matrix.pointers[p], end = matrix.pointers[p + 1];
+        output.push_back(reference_internal::mean(matrix.data, start, end, static_cast<std::size_t>(matrix.secondary) - (end - start)));
+    }
+    return output;
+}
+
+/**
+ * Compute reference sample variances for each primary dimension element of a compressed sparse matrix.
+ * Each variance is computed as described for `reference_variance()`, including the structural zeros.
+ *
+ * @tparam Data_ Numeric type of the data.
+ * @tparam Index_ Integer type of the indices.
+ * @tparam Pointer_ Integer type of the compressed sparse pointers.
+ *
+ * @param matrix Contents of a compressed sparse matrix.
+ * @return Vector of reference variances, one per primary dimension element.
+ */
+template<typename Data_, typename Index_, typename Pointer_>
+std::vector<ReferenceResult> reference_sparse_variances(const SimulatedCompressedSparseMatrix<Data_, Index_, Pointer_>& matrix) {
+    std::vector<ReferenceResult> output;
+    output.reserve(matrix.primary);
+    for (Index_ p = 0; p < matrix.primary; ++p) {
+        const std::size_t start = matrix.pointers[p], end = matrix.pointers[p + 1];
+        output.push_back(reference_internal::variance(matrix.data, start, end, static_cast<std::size_t>(matrix.secondary) - (end - start)));
+    }
+    return output;
+}
+
+/**
+ * @brief Parameters for `compare_to_reference()`.
+ */
+struct CompareToReferenceParameters {
+    /**
+     * Multiplier for `ReferenceResult::tolerance`.
+     * This can be increased for implementations that perform additional operations beyond the standard algorithm.
+     */
+    double multiplier = 1;
+
+    /**
+     * Whether to report a mismatch as a test failure in GoogleTest.
+     */
+    bool report = true;
+};
+
+/**
+ * Check if a computed value is consistent with a reference result.
+ * This is true if the computed value lies within `ReferenceResult::tolerance` (scaled by `CompareToReferenceParameters::multiplier`) of the exact result,
+ * accounting for the uncertainty in the reference value itself.
+ * Unlike `compare_almost_equal()`, this does not require a guessed relative tolerance.
+ *
+ * If the reference value is NaN, the computed value is only considered to be consistent if it is also NaN.
+ *
+ * @param computed Value computed by the implementation under test.
+ * @param reference Reference result, e.g., from `reference_sum()`.
+ * @param params Further parameters.
+ *
+ * @return Whether the computed value is consistent with the reference.
+ */
+inline bool compare_to_reference(double computed, const ReferenceResult& reference, const CompareToReferenceParameters& params) {
+    if (std::isnan(reference.value) || std::isnan(computed)) {
+        if (std::isnan(reference.value) != std::isnan(computed)) {
+            if (params.report) {
+                EXPECT_TRUE(false) << "mismatching NaN status (" << computed << " versus reference " << reference.value << ")";
+            }
+            return false;
+        }
+        return true;
+    }
+
+    const double bound = reference.tolerance * params.multiplier + reference.error;
+    const double diff = std::abs(computed - reference.value);
+    if (diff > bound) {
+        if (params.report) {
+            EXPECT_TRUE(false) << "value exceeds reference bound (" << computed << " versus reference " << reference.value << ", difference of " << diff << " exceeds bound of " << bound << ")";
+        }
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Check if a vector of computed values is consistent with a vector of reference results.
+ * This compares the corresponding elements from each vector using `compare_to_reference()`.
+ * Any test failure is reported via GoogleTest.
+ *
+ * @tparam Container_ Vector-like container of floating-point values.
+ *
+ * @param computed Vector of computed values.
+ * @param reference Vector of reference results, of the same length as `computed`.
+ * @param params Further parameters.
+ * Note that `CompareToReferenceParameters::report` is ignored,
+ * any mismatching value will always be reported.
+ */
+template<class Container_>
+void compare_to_reference_containers(const Container_& computed, const std::vector<ReferenceResult>& reference, CompareToReferenceParameters params) {
+    auto n = computed.size();
+    ASSERT_EQ(n, reference.size());
+
+    params.report = false;
+    for (decltype(n) i = 0; i < n; ++i) {
+        if (!compare_to_reference(computed[i], reference[i], params)) {
+            EXPECT_TRUE(false) << "value exceeds reference bound at element " << i << " (expected " << reference[i].value << ", got " << computed[i] << ")";
+            return;
+        }
+    }
+}
+
+}
+
+#endif
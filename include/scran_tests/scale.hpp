@@ -0,0 +1,252 @@
+#ifndef SCRAN_TESTS_SCALE_HPP
+#define SCRAN_TESTS_SCALE_HPP
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include "simulate_vector.hpp"
+#include "simulate_compressed_sparse_matrix.hpp"
+
+/**
+ * @file scale.hpp
+ * @brief Scale test fixtures up to production-sized inputs.
+ */
+
+/**
+ * Default scale factor, used if the `SCRAN_TESTS_SCALE` environment variable is not set.
+ * This is usually defined via the `SCRAN_TESTS_SCALE` CMake option.
+ */
+#ifndef SCRAN_TESTS_DEFAULT_SCALE
+#define SCRAN_TESTS_DEFAULT_SCALE 1
+#endif
+
+namespace scran_tests {
+
+/**
+ * @cond
+ */
+inline double parse_scale_factor(const char* value, double fallback) {
+    if (value == NULL || *value == '\0') {
+        return fallback;
+    }
+
+    char* end;
+    double parsed = std::strtod(value, &end);
+    if (*end != '\0' || !std::isfinite(parsed) || parsed <= 0) {
+        throw std::runtime_error("scale factor should be a positive number, got '" + std::string(value) + "'");
+    }
+    return parsed;
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Scale factor for test fixtures.
+ * This is taken from the `SCRAN_TESTS_SCALE` environment variable if set, otherwise it defaults to `SCRAN_TESTS_DEFAULT_SCALE`.
+ * The value is read once and cached for the lifetime of the process.
+ *
+ * A scale factor of 1 runs the tests at their usual size.
+ * Larger values turn the same test suite into a production-scale load test,
+ * via fixtures created by `simulate_scaled_vector()`, `simulate_scaled_compressed_sparse_matrix()` or `scale_extent()`.
+ *
+ * @return The scale factor, always positive.
+ */
+inline double scale_factor() {
+    static const double factor = parse_scale_factor(std::getenv("SCRAN_TESTS_SCALE"), SCRAN_TESTS_DEFAULT_SCALE);
+    return factor;
+}
+
+/**
+ * @return Whether the fixtures are scaled up, i.e., `scale_factor()` is greater than 1.
+ * If true, the `simulate_scaled_*` functions and `ScaleTimer` will report timings and memory usage.
+ */
+inline bool is_scaled_up() {
+    return scale_factor() > 1;
+}
+
+/**
+ * Scale an extent by a given factor.
+ * The result is rounded to the nearest integer and is at least 1 if `extent` is positive.
+ * An error is raised if the scaled extent does not fit in `Size_`, or if `factor` is not a finite positive number.
+ *
+ * @tparam Size_ Integer type of the extent.
+ *
+ * @param extent Extent to be scaled, typically the unscaled size of a fixture.
+ * @param factor Scale factor, should be positive.
+ *
+ * @return The scaled extent.
+ */
+template<typename Size_>
+Size_ scale_extent(Size_ extent, double factor) {
+    static_assert(std::is_integral<Size_>::value);
+    if (!std::isfinite(factor) || factor <= 0) {
+        throw std::runtime_error("scale factor should be a positive number");
+    }
+    if (extent <= 0 || factor == 1) {
+        return extent;
+    }
+
+    // Comparing to 'max + 1', which is an exact power of two; the maximum itself may be rounded up when converted to a double (e.g., to 2^64).
+    const double scaled = std::round(static_cast<double>(extent) * factor);
+    if (scaled >= std::ldexp(1.0, std::numeric_limits<Size_>::digits)) {
+        throw std::overflow_error("scaled extent does not fit in the integer type");
+    }
+    if (scaled < 1) {
+        return 1;
+    }
+    return static_cast<Size_>(scaled);
+}
+
+/**
+ * Overload of `scale_extent()` that uses `scale_factor()`.
+ *
+ * @tparam Size_ Integer type of the extent.
+ * @param extent Extent to be scaled.
+ * @return The scaled extent.
+ */
+template<typename Size_>
+Size_ scale_extent(Size_ extent) {
+    return scale_extent(extent, scale_factor());
+}
+
+/**
+ * @return Peak resident set size of the current process in bytes, or 0 if this cannot be determined on the current platform.
+ */
+inline std::size_t peak_memory_usage() {
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return usage.ru_maxrss; // already in bytes.
+#else
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024; // kilobytes on Linux and the BSDs.
+#endif
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Report the time and memory usage of a block of code in scaled-up runs.
+ *
+ * On destruction, this prints the wall time since construction to `std::cerr`,
+ * along with the peak memory usage of the process and its increase since construction.
+ * This is only done if `is_scaled_up()` is true at construction.
+ * Otherwise, it does nothing, so that regular unit tests remain quiet.
+ */
+class ScaleTimer {
+public:
+    /**
+     * @param name Name of the timed block, to be used in the report.
+     */
+    ScaleTimer(std::string name) : 
+        my_name(std::move(name)),
+        my_factor(scale_factor()),
+        my_start_peak(peak_memory_usage()),
+        my_start(std::chrono::steady_clock::now())
+    {}
+
+    /**
+     * @cond
+     */
+    ScaleTimer(const ScaleTimer&) = delete;
+    ScaleTimer& operator=(const ScaleTimer&) = delete;
+
+    // The scale factor is stored in the constructor, as scale_factor() may throw on an invalid SCRAN_TESTS_SCALE.
+    ~ScaleTimer() {
+        if (my_factor > 1) {
+            std::cerr << "[scran_tests] " << my_name << ": " << elapsed() << " s, peak memory " << peak_memory_usage() 
+                << " bytes (+" << peak_memory_increase() << " during block, scale " << my_factor << ")" << std::endl;
+        }
+    }
+    /**
+     * @endcond
+     */
+
+    /**
+     * @return Wall time in seconds since construction.
+     */
+    double elapsed() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - my_start).count();
+    }
+
+    /**
+     * @return Increase in the peak memory usage of the process since construction, in bytes.
+     * This is zero if the block did not exceed the previous peak, or if `peak_memory_usage()` is not supported on the current platform.
+     */
+    std::size_t peak_memory_increase() const {
+        const auto current = peak_memory_usage();
+        return (current > my_start_peak ? current - my_start_peak : 0);
+    }
+
+private:
+    std::string my_name;
+    double my_factor;
+    std::size_t my_start_peak;
+    std::chrono::steady_clock::time_point my_start;
+};
+
+/**
+ * Wrapper around `simulate_vector()` where the length is scaled by `scale_extent()`.
+ * Timing and memory usage are reported via `ScaleTimer`.
+ *
+ * @tparam Type_ Numeric type of the simulated value.
+ *
+ * @param length Unscaled length of the vector.
+ * @param params Simulation parameters.
+ *
+ * @return Vector of simulated values.
+ */
+template<typename Type_ = double>
+std::vector<Type_> simulate_scaled_vector(typename std::vector<Type_>::size_type length, const SimulateVectorParameters<Type_>& params) {
+    length = scale_extent(length);
+    ScaleTimer timer("simulate_vector(" + std::to_string(length) + ")");
+    return simulate_vector<Type_>(length, params);
+}
+
+/**
+ * Wrapper around `simulate_compressed_sparse_matrix()` where each extent is scaled by `scale_extent()`.
+ * Note that the number of elements in the matrix increases with the square of `scale_factor()`.
+ * Timing and memory usage are reported via `ScaleTimer`.
+ *
+ * @tparam Data_ Numeric type of the data.
+ * @tparam Index_ Integer type of the indices.
+ * @tparam Pointer_ Integer type of the compressed sparse pointers.
+ *
+ * @param primary Unscaled extent of the primary dimension.
+ * @param secondary Unscaled extent of the secondary dimension.
+ * @param params Simulation parameters.
+ *
+ * @return Contents of a simulated compressed sparse matrix.
+ */
+template<typename Data_ = double, typename Index_ = int, typename Pointer_ = std::size_t>
+SimulatedCompressedSparseMatrix<Data_, Index_, Pointer_> simulate_scaled_compressed_sparse_matrix(
+    Index_ primary,
+    Index_ secondary,
+    const SimulateCompressedSparseMatrixParameters<Data_>& params
+) {
+    primary = scale_extent(primary);
+    secondary = scale_extent(secondary);
+    ScaleTimer timer("simulate_compressed_sparse_matrix(" + std::to_string(primary) + ", " + std::to_string(secondary) + ")");
+    return simulate_compressed_sparse_matrix<Data_, Index_, Pointer_>(primary, secondary, params);
+}
+
+}
+
+#endif
@@ -2,9 +2,13 @@
 #define SCRAN_TESTS_HPP
 
 #include "compare_almost_equal.hpp"
+#include "reference_reduction.hpp"
 #include "vector_n.hpp"
 #include "simulate_vector.hpp"
 #include "simulate_compressed_sparse_matrix.hpp"
+#include "simulate_compressed_sparse_chunks.hpp"
+#include "type_limit_fixtures.hpp"
+#include "scale.hpp"
 #include "expect_error.hpp"
 #include "initial_value.hpp"
 
@@ -0,0 +1,214 @@
+#ifndef SCRAN_TESTS_SIMULATE_COMPRESSED_SPARSE_CHUNKS_HPP
+#define SCRAN_TESTS_SIMULATE_COMPRESSED_SPARSE_CHUNKS_HPP
+
+#include <random>
+#include <vector>
+#include <thread>
+#include <exception>
+#include <stdexcept>
+#include <algorithm>
+#include <cstddef>
+
+#include "simulate_vector.hpp"
+#include "simulate_compressed_sparse_matrix.hpp"
+
+/**
+ * @file simulate_compressed_sparse_chunks.hpp
+ * @brief Simulate a compressed sparse matrix in chunks along the primary dimension.
+ */
+
+namespace scran_tests {
+
+/**
+ * @brief Chunk of a simulated compressed sparse matrix.
+ *
+ * @tparam Data_ Numeric type of the data.
+ * @tparam Index_ Integer type of the indices.
+ * @tparam Pointer_ Integer type of the compressed sparse pointers.
+ */
+template<typename Data_, typename Index_, typename Pointer_>
+struct SimulatedCompressedSparseChunk {
+    /**
+     * Index of the first primary dimension element in this chunk.
+     */
+    Index_ start;
+
+    /**
+     * Number of primary dimension elements in this chunk.
+     */
+    Index_ length;
+
+    /**
+     * Extent of the secondary dimension.
+     */
+    Index_ secondary;
+
+    /**
+     * Values of the structural non-zero elements in this chunk.
+     */
+    std::vector<Data_> data;
+
+    /**
+     * Indices of the structural non-zero elements in this chunk, along the secondary dimension.
+     */
+    std::vector<Index_> index;
+
+    /**
+     * Pointers specifying the first and last non-zero element for each primary dimension element in this chunk.
+     * These are local to the chunk, i.e., the first pointer is always zero.
+     */
+    std::vector<Pointer_> pointers;
+};
+
+/**
+ * @brief Simulate a compressed sparse matrix in consecutive chunks along the primary dimension.
+ *
+ * This is intended for testing streaming algorithms that consume a matrix block by block.
+ * Each chunk is generated in a background thread while the caller is processing the previous chunk,
+ * so generation time is mostly hidden and only two chunks are held in memory at any time.
+ * Concatenating all chunks yields the same matrix as `simulate_compressed_sparse_matrix()` with the same parameters.
+ *
+ * @tparam Data_ Numeric type of the data.
+ * @tparam Index_ Integer type of the indices.
+ * @tparam Pointer_ Integer type of the compressed sparse pointers.
+ */
+template<typename Data_ = double, typename Index_ = int, typename Pointer_ = std::size_t>
+class CompressedSparseChunkSimulator {
+public:
+    /**
+     * @param primary Extent of the primary dimension, see `simulate_compressed_sparse_matrix()` for details.
+     * @param secondary Extent of the secondary dimension.
+     * An error is raised if either extent is negative.
+     * @param chunk_size Number of primary dimension elements in each chunk.
+     * This should be positive; the last chunk may be smaller.
+     * @param params Simulation parameters.
+     */
+    CompressedSparseChunkSimulator(Index_ primary, Index_ secondary, Index_ chunk_size, const SimulateCompressedSparseMatrixParameters<Data_>& params) :
+        my_primary(primary),
+        my_secondary(secondary),
+        my_chunk_size(chunk_size),
+        my_density(params.density),
+        my_rng(params.seed),
+        my_unif(create_simulating_distribution(params.lower, params.upper)),
+        my_nonzero(0.0, 1.0)
+    {
+        check_compressed_sparse_extent(primary);
+        check_compressed_sparse_extent(secondary);
+        if (chunk_size <= 0) {
+            throw std::runtime_error("chunk size should be positive");
+        }
+        launch();
+    }
+
+    /**
+     * @cond
+     */
+    CompressedSparseChunkSimulator(const CompressedSparseChunkSimulator&) = delete;
+    CompressedSparseChunkSimulator& operator=(const CompressedSparseChunkSimulator&) = delete;
+
+    ~CompressedSparseChunkSimulator() {
+        if (my_worker.joinable()) {
+            my_worker.join();
+        }
+    }
+    /**
+     * @endcond
+     */
+
+    /**
+     * Fetch the next chunk, waiting for the background thread if it has not yet finished generating it.
+     * This also starts generation of the subsequent chunk in the background.
+     *
+     * @return Pointer to the next chunk, or NULL if all chunks have been returned.
+     * The pointed-to chunk is only valid until the next call to `next()`.
+     * If generation of a chunk failed, the error is rethrown by this call and all later calls.
+     */
+    const SimulatedCompressedSparseChunk<Data_, Index_, Pointer_>* next() {
+        if (!my_worker.joinable()) {
+            // Once an error is raised, it is raised on every subsequent call so that it can't be mistaken for the end of the stream.
+            // This is only safe to check if there is no running worker, as the worker may otherwise be writing to 'my_error'.
+            if (my_error) {
+                std::rethrow_exception(my_error);
+            }
+            return NULL;
+        }
+
+        my_worker.join();
+        if (my_error) {
+            std::rethrow_exception(my_error);
+        }
+
+        // The caller's previous chunk is now free for re-use by the background thread.
+        const int ready = my_filling;
+        my_filling = 1 - ready;
+        launch();
+        return &(my_buffers[ready]);
+    }
+
+    /**
+     * @return Extent of the primary dimension.
+     */
+    Index_ primary() const {
+        return my_primary;
+    }
+
+    /**
+     * @return Extent of the secondary dimension.
+     */
+    Index_ secondary() const {
+        return my_secondary;
+    }
+
+private:
+    Index_ my_primary, my_secondary, my_chunk_size;
+    Index_ my_next_start = 0;
+
+    double my_density;
+    RngEngine my_rng;
+    decltype(create_simulating_distribution(Data_(), Data_())) my_unif;
+    std::uniform_real_distribution<double> my_nonzero;
+
+    SimulatedCompressedSparseChunk<Data_, Index_, Pointer_> my_buffers[2];
+    int my_filling = 0;
+    std::thread my_worker;
+    std::exception_ptr my_error;
+
+    void launch() {
+        if (my_next_start >= my_primary) {
+            return;
+        }
+
+        const Index_ start = my_next_start;
+        const Index_ length = std::min<Index_>(my_chunk_size, my_primary - start);
+        my_next_start += length;
+
+        // Only the worker touches the RNG and the filling buffer until it is joined in next().
+        my_worker = std::thread([this, start, length]() -> void {
+            try {
+                fill(my_buffers[my_filling], start, length);
+            } catch (...) {
+                my_error = std::current_exception();
+            }
+        });
+    }
+
+    void fill(SimulatedCompressedSparseChunk<Data_, Index_, Pointer_>& chunk, Index_ start, Index_ length) {
+        chunk.start = start;
+        chunk.length = length;
+        chunk.secondary = my_secondary;
+        chunk.data.clear();
+        chunk.index.clear();
+        chunk.pointers.clear();
+        chunk.pointers.reserve(static_cast<typename std::vector<Pointer_>::size_type>(length) + 1);
+        chunk.pointers.push_back(0);
+
+        for (Index_ p = 0; p < length; ++p) {
+            simulate_compressed_sparse_primary(my_secondary, my_density, my_rng, my_unif, my_nonzero, chunk.data, chunk.index);
+            chunk.pointers.push_back(cast_compressed_sparse_pointer<Pointer_>(chunk.index.size()));
+        }
+    }
+};
+
+}
+
+#endif
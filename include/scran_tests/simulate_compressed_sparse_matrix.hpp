@@ -5,6 +5,9 @@
 #include <vector>
 #include <type_traits>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
 
 #include "simulate_vector.hpp"
 
@@ -79,6 +82,53 @@ struct SimulatedCompressedSparseMatrix {
     std::vector<Pointer_> pointers;
 };
 
+/**
+ * @cond
+ */
+// Converts the number of non-zeros so far into a pointer, checking that it doesn't wrap around.
+template<typename Pointer_>
+Pointer_ cast_compressed_sparse_pointer(std::size_t n) {
+    if constexpr(static_cast<std::uintmax_t>(std::numeric_limits<Pointer_>::max()) < static_cast<std::uintmax_t>(std::numeric_limits<std::size_t>::max())) {
+        if (n > static_cast<std::size_t>(std::numeric_limits<Pointer_>::max())) {
+            throw std::overflow_error("number of structural non-zero elements overflows the pointer type");
+        }
+    }
+    return n;
+}
+
+// Checks that a user-supplied extent is non-negative, before it gets cast to a huge unsigned size.
+template<typename Index_>
+void check_compressed_sparse_extent(Index_ extent) {
+    if constexpr(std::is_signed<Index_>::value) {
+        if (extent < 0) {
+            throw std::runtime_error("extent should be non-negative");
+        }
+    }
+}
+
+// Simulates the structural non-zeros for a single primary dimension element.
+// This is shared with the chunked simulator so that both consume the RNG stream in the same order.
+template<typename Data_, typename Index_, class Unif_>
+void simulate_compressed_sparse_primary(
+    Index_ secondary,
+    double density,
+    RngEngine& rng,
+    Unif_& unif,
+    std::uniform_real_distribution<double>& nonzero,
+    std::vector<Data_>& data,
+    std::vector<Index_>& index
+) {
+    for (Index_ s = 0; s < secondary; ++s) {
+        if (nonzero(rng) <= density) {
+            index.push_back(s);
+            data.push_back(unif(rng));
+        }
+    }
+}
+/**
+ * @endcond
+ */
+
 /**
  * @tparam Data_ Numeric type of the data.
  * @tparam Index_ Integer type of the indices.
@@ -90,6 +140,7 @@ struct SimulatedCompressedSparseMatrix {
  * @param params Simulation parameters.
  *
  * @return Contents of a simulated compressed sparse matrix.
+ * An error is raised if either extent is negative, or if the number of structural non-zero elements cannot be represented by `Pointer_`.
  */
 template<typename Data_ = double, typename Index_ = int, typename Pointer_ = std::size_t>
 SimulatedCompressedSparseMatrix<Data_, Index_, Pointer_> simulate_compressed_sparse_matrix(
@@ -97,6 +148,8 @@ SimulatedCompressedSparseMatrix<Data_, Index_, Pointer_> simulate_compressed_spa
     Index_ secondary,
     const SimulateCompressedSparseMatrixParameters<Data_>& params
 ) {
+    check_compressed_sparse_extent(primary);
+    check_compressed_sparse_extent(secondary);
     RngEngine rng(params.seed);
     auto unif = create_simulating_distribution(params.lower, params.upper);
 
@@ -108,13 +161,8 @@ SimulatedCompressedSparseMatrix<Data_, Index_, Pointer_> simulate_compressed_spa
 
     std::uniform_real_distribution<double> nonzero(0.0, 1.0);
     for (Index_ p = 0; p < primary; ++p) {
-        for (Index_ s = 0; s < secondary; ++s) {
-            if (nonzero(rng) <= params.density) {
-                output.index.push_back(s);
-                output.data.push_back(unif(rng));
-            }
-        }
-        output.pointers.push_back(output.index.size());
+        simulate_compressed_sparse_primary(secondary, params.density, rng, unif, nonzero, output.data, output.index);
+        output.pointers.push_back(cast_compressed_sparse_pointer<Pointer_>(output.index.size()));
     }
 
     return output;
@@ -0,0 +1,153 @@
+#ifndef SCRAN_TESTS_TYPE_LIMIT_FIXTURES_HPP
+#define SCRAN_TESTS_TYPE_LIMIT_FIXTURES_HPP
+
+#include <vector>
+#include <limits>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "simulate_compressed_sparse_matrix.hpp"
+
+/**
+ * @file type_limit_fixtures.hpp
+ * @brief Fixtures at the limits of compact index and pointer types.
+ */
+
+namespace scran_tests {
+
+/**
+ * Simulate a compressed sparse matrix where the secondary extent is equal to the maximum value of `Index_`.
+ * This ensures that the largest possible index (i.e., one less than the maximum) can be present,
+ * which is useful for checking that code using narrow index types (e.g., `uint16_t`) does not wrap around when iterating over the secondary dimension.
+ *
+ * Every cell of the matrix is visited during simulation, so this is only practical for narrow `Index_`.
+ * The last secondary element is always a structural non-zero for each primary element, regardless of `SimulateCompressedSparseMatrixParameters::density`.
+ *
+ * @tparam Data_ Numeric type of the data.
+ * @tparam Index_ Integer type of the indices.
+ * @tparam Pointer_ Integer type of the compressed sparse pointers.
+ *
+ * @param primary Extent of the primary dimension.
+ * An error is raised if this is negative.
+ * @param params Simulation parameters.
+ * Users should typically set a low `SimulateCompressedSparseMatrixParameters::density` to keep the number of non-zeros manageable.
+ * An error is raised if the range of simulated values does not contain any non-zero value.
+ *
+ * @return Contents of a simulated compressed sparse matrix with a secondary extent of `std::numeric_limits<Index_>::max()`.
+ */
+template<typename Data_ = double, typename Index_ = std::uint16_t, typename Pointer_ = std::size_t>
+SimulatedCompressedSparseMatrix<Data_, Index_, Pointer_> simulate_compressed_sparse_matrix_at_index_limit(Index_ primary, const SimulateCompressedSparseMatrixParameters<Data_>& params) {
+    constexpr Index_ secondary = std::numeric_limits<Index_>::max();
+    auto output = simulate_compressed_sparse_matrix<Data_, Index_, Pointer_>(primary, secondary, params);
+
+    // Forcing the presence of the largest index in each primary element.
+    auto unif = create_simulating_distribution(params.lower, params.upper);
+    RngEngine rng(params.seed);
+    Data_ value = unif(rng);
+    if (value == 0) {
+        // Zero lies in [lower, upper), so we pick a non-zero value from either side of it, if one exists.
+        if constexpr(std::is_floating_point<Data_>::value) {
+            value = params.upper / 2;
+        } else if (params.upper - 1 > 0) {
+            value = params.upper - 1;
+        } else {
+            value = params.lower;
+        }
+        if (value == 0) {
+            throw std::runtime_error("range of simulated values should contain a non-zero value");
+        }
+    }
+
+    std::vector<Data_> data;
+    std::vector<Index_> index;
+    std::vector<Pointer_> pointers;
+    data.reserve(output.data.size() + primary);
+    index.reserve(output.index.size() + primary);
+    pointers.reserve(output.pointers.size());
+    pointers.push_back(0);
+
+    for (Index_ p = 0; p < primary; ++p) {
+        const auto start = output.pointers[p], end = output.pointers[p + 1];
+        data.insert(data.end(), output.data.begin() + start, output.data.begin() + end);
+        index.insert(index.end(), output.index.begin() + start, output.index.begin() + end);
+        if (start == end || index.back() != secondary - 1) {
+            data.push_back(value);
+            index.push_back(secondary - 1);
+        }
+        pointers.push_back(cast_compressed_sparse_pointer<Pointer_>(index.size()));
+    }
+
+    output.data.swap(data);
+    output.index.swap(index);
+    output.pointers.swap(pointers);
+    return output;
+}
+
+/**
+ * @tparam Pointer_ Integer type of the compressed sparse pointers.
+ * This should be narrower than `std::uintmax_t`, e.g., `std::uint32_t`.
+ * @return Smallest number of structural non-zero elements that cannot be represented by `Pointer_`, e.g., \f$2^{32}\f$ for `std::uint32_t`.
+ */
+template<typename Pointer_>
+constexpr std::uintmax_t first_overflowing_nnz() {
+    static_assert(std::is_integral<Pointer_>::value);
+    static_assert(static_cast<std::uintmax_t>(std::numeric_limits<Pointer_>::max()) < std::numeric_limits<std::uintmax_t>::max());
+    return static_cast<std::uintmax_t>(std::numeric_limits<Pointer_>::max()) + 1;
+}
+
+/**
+ * Simulate the pointers of a compressed sparse matrix with a specified total number of structural non-zero elements,
+ * without allocating the corresponding data or indices.
+ * This allows testing of pointer arithmetic on matrices that are too large to actually create,
+ * e.g., with `nnz` just over \f$2^{32}\f$ to compare 32-bit and 64-bit pointers.
+ *
+ * Non-zeros are spread as evenly as possible across the primary dimension elements.
+ * An error is raised if either extent is negative, if `nnz` exceeds the number of cells in the matrix, or if `nnz` cannot be represented by `Pointer_`.
+ *
+ * @tparam Pointer_ Integer type of the compressed sparse pointers.
+ * @tparam Index_ Integer type of the extents.
+ *
+ * @param primary Extent of the primary dimension.
+ * @param secondary Extent of the secondary dimension.
+ * @param nnz Total number of structural non-zero elements.
+ *
+ * @return Vector of pointers of length `primary + 1`, where the last element is equal to `nnz`.
+ */
+template<typename Pointer_ = std::size_t, typename Index_ = int>
+std::vector<Pointer_> simulate_compressed_sparse_pointers(Index_ primary, Index_ secondary, std::uintmax_t nnz) {
+    check_compressed_sparse_extent(primary);
+    check_compressed_sparse_extent(secondary);
+    if (primary == 0) {
+        if (nnz > 0) {
+            throw std::runtime_error("number of structural non-zero elements exceeds the number of cells");
+        }
+        return std::vector<Pointer_>(1);
+    }
+
+    const std::uintmax_t per_primary = nnz / static_cast<std::uintmax_t>(primary);
+    const std::uintmax_t remainder = nnz % static_cast<std::uintmax_t>(primary);
+    const std::uintmax_t max_secondary = secondary;
+    if (per_primary > max_secondary || (per_primary == max_secondary && remainder > 0)) {
+        throw std::runtime_error("number of structural non-zero elements exceeds the number of cells");
+    }
+    if (static_cast<std::uintmax_t>(std::numeric_limits<Pointer_>::max()) < nnz) {
+        throw std::overflow_error("number of structural non-zero elements overflows the pointer type");
+    }
+
+    std::vector<Pointer_> pointers;
+    pointers.reserve(static_cast<typename std::vector<Pointer_>::size_type>(primary) + 1);
+    pointers.push_back(0);
+    std::uintmax_t current = 0;
+    for (Index_ p = 0; p < primary; ++p) {
+        current += per_primary + (static_cast<std::uintmax_t>(p) < remainder);
+        pointers.push_back(current);
+    }
+
+    return pointers;
+}
+
+}
+
+#endif
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "scran_tests/reference_reduction.hpp"
+#include "scran_tests/simulate_vector.hpp"
+#include "scran_tests/simulate_compressed_sparse_matrix.hpp"
+#include "scran_tests/expect_error.hpp"
+
+static double naive_sum(const std::vector<double>& x) {
+    double total = 0;
+    for (auto v : x) {
+        total += v;
+    }
+    return total;
+}
+
+static double pairwise_sum(const double* ptr, std::size_t n) {
+    if (n <= 4) {
+        double total = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            total += ptr[i];
+        }
+        return total;
+    }
+    const auto half = n / 2;
+    return pairwise_sum(ptr, half) + pairwise_sum(ptr + half, n - half);
+}
+
+static double naive_variance(const std::vector<double>& x) {
+    const double mean = naive_sum(x) / x.size();
+    double ss = 0;
+    for (auto v : x) {
+        ss += (v - mean) * (v - mean);
+    }
+    return ss / (x.size() - 1);
+}
+
+TEST(ReferenceReduction, Cancellation) {
+    std::vector<double> x{ 1e16, 1, -1e16 };
+    auto ref = scran_tests::reference_sum(x);
+    EXPECT_EQ(ref.value, 1);
+    EXPECT_LT(ref.error, 1e-10);
+
+    // Naive summation loses the 1, but this is still within the provable bound.
+    EXPECT_EQ(naive_sum(x), 0);
+    EXPECT_TRUE(scran_tests::compare_to_reference(naive_sum(x), ref, {}));
+
+    auto mref = scran_tests::reference_mean(x);
+    EXPECT_EQ(mref.value, 1.0/3);
+}
+
+TEST(ReferenceReduction, Sum) {
+    auto x = scran_tests::simulate_vector(10000, scran_tests::SimulateVectorParameters());
+    auto ref = scran_tests::reference_sum(x);
+
+    scran_tests::CompareToReferenceParameters params;
+    EXPECT_TRUE(scran_tests::compare_to_reference(naive_sum(x), ref, params));
+    EXPECT_TRUE(scran_tests::compare_to_reference(pairwise_sum(x.data(), x.size()), ref, params));
+
+    auto rev = x;
+    std::reverse(rev.begin(), rev.end());
+    EXPECT_TRUE(scran_tests::compare_to_reference(naive_sum(rev), ref, params));
+
+    params.report = false;
+    EXPECT_FALSE(scran_tests::compare_to_reference(ref.value + 10 * ref.tolerance + 1e-8, ref, params));
+    params.multiplier = 1e10;
+    EXPECT_TRUE(scran_tests::compare_to_reference(ref.value + 10 * ref.tolerance + 1e-8, ref, params));
+}
+
+TEST(ReferenceReduction, Mean) {
+    auto x = scran_tests::simulate_vector(5000, scran_tests::SimulateVectorParameters());
+    auto ref = scran_tests::reference_mean(x);
+    EXPECT_TRUE(scran_tests::compare_to_reference(naive_sum(x) / x.size(), ref, {}));
+    EXPECT_TRUE(scran_tests::compare_to_reference(pairwise_sum(x.data(), x.size()) / x.size(), ref, {}));
+
+    auto empty = scran_tests::reference_mean(std::vector<double>());
+    EXPECT_TRUE(std::isnan(empty.value));
+}
+
+TEST(ReferenceReduction, Variance) {
+    std::vector<double> simple{ 1, 2, 3, 4 };
+    auto sref = scran_tests::reference_variance(simple);
+    EXPECT_EQ(sref.value, 5.0/3);
+
+    // Adding a large offset so that the one-pass algorithm suffers from catastrophic cancellation.
+    auto x = scran_tests::simulate_vector(1000, scran_tests::SimulateVectorParameters());
+    for (auto& v : x) {
+        v += 1e8;
+    }
+    auto ref = scran_tests::reference_variance(x);
+    EXPECT_TRUE(scran_tests::compare_to_reference(naive_variance(x), ref, {}));
+
+    double sum = 0, sumsq = 0;
+    for (auto v : x) {
+        sum += v;
+        sumsq += v * v;
+    }
+    const double n = x.size();
+    const double one_pass = (sumsq - sum * sum / n) / (n - 1);
+    scran_tests::CompareToReferenceParameters params;
+    params.report = false;
+    EXPECT_FALSE(scran_tests::compare_to_reference(one_pass, ref, params));
+
+    auto single = scran_tests::reference_variance(std::vector<double>{ 1 });
+    EXPECT_TRUE(std::isnan(single.value));
+}
+
+TEST(ReferenceReduction, Dot) {
+    auto x = scran_tests::simulate_vector(1000, scran_tests::SimulateVectorParameters());
+    auto y = scran_tests::simulate_vector(1000, [&]{
+        scran_tests::SimulateVectorParameters params;
+        params.seed = 42;
+        return params;
+    }());
+
+    auto ref = scran_tests::reference_dot(x, y);
+    double naive = 0;
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        naive += x[i] * y[i];
+    }
+    EXPECT_TRUE(scran_tests::compare_to_reference(naive, ref, {}));
+
+    std::vector<double> a{ 1e16, 1, -1e16 }, b{ 1, 1, 1 };
+    EXPECT_EQ(scran_tests::reference_dot(a, b).value, 1);
+
+    std::vector<double> shorter{ 1, 1 };
+    scran_tests::expect_error([&]() { scran_tests::reference_dot(a, shorter); }, "same length");
+}
+
+TEST(ReferenceReduction, Sparse) {
+    auto mat = scran_tests::simulate_compressed_sparse_matrix(20, 100, scran_tests::SimulateCompressedSparseMatrixParameters());
+    auto sums = scran_tests::reference_sparse_sums(mat);
+    auto means = scran_tests::reference_sparse_means(mat);
+    auto vars = scran_tests::reference_sparse_variances(mat);
+    ASSERT_EQ(sums.size(), 20);
+    ASSERT_EQ(means.size(), 20);
+    ASSERT_EQ(vars.size(), 20);
+
+    std::vector<double> computed_sums, computed_means, computed_vars;
+    for (int p = 0; p < mat.primary; ++p) {
+        std::vector<double> dense(mat.secondary);
+        for (auto i = mat.pointers[p]; i < mat.pointers[p + 1]; ++i) {
+            dense[mat.index[i]] = mat.data[i];
+        }
+        computed_sums.push_back(naive_sum(dense));
+        computed_means.push_back(naive_sum(dense) / dense.size());
+        computed_vars.push_back(naive_variance(dense));
+
+        auto ref_var = scran_tests::reference_variance(dense);
+        EXPECT_TRUE(std::abs(ref_var.value - vars[p].value) <= ref_var.error + vars[p].error);
+    }
+
+    scran_tests::compare_to_reference_containers(computed_sums, sums, {});
+    scran_tests::compare_to_reference_containers(computed_means, means, {});
+    scran_tests::compare_to_reference_containers(computed_vars, vars, {});
+}
+
+TEST(ReferenceReduction, NaN) {
+    constexpr auto nan = std::numeric_limits<double>::quiet_NaN();
+    scran_tests::CompareToReferenceParameters params;
+    params.report = false;
+    EXPECT_TRUE(scran_tests::compare_to_reference(nan, scran_tests::ReferenceResult{ nan, 0, 0 }, params));
+    EXPECT_FALSE(scran_tests::compare_to_reference(1, scran_tests::ReferenceResult{ nan, 0, 0 }, params));
+    EXPECT_FALSE(scran_tests::compare_to_reference(nan, scran_tests::ReferenceResult{ 1, 0, 0 }, params));
+}
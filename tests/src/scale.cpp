@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "scran_tests/scale.hpp"
+#include "scran_tests/expect_error.hpp"
+
+TEST(Scale, Parse) {
+    EXPECT_EQ(scran_tests::parse_scale_factor(NULL, 1), 1);
+    EXPECT_EQ(scran_tests::parse_scale_factor("", 2), 2);
+    EXPECT_EQ(scran_tests::parse_scale_factor("10", 1), 10);
+    EXPECT_EQ(scran_tests::parse_scale_factor("0.5", 1), 0.5);
+
+    scran_tests::expect_error([&]() { scran_tests::parse_scale_factor("foo", 1); }, "positive number");
+    scran_tests::expect_error([&]() { scran_tests::parse_scale_factor("10x", 1); }, "positive number");
+    scran_tests::expect_error([&]() { scran_tests::parse_scale_factor("0", 1); }, "positive number");
+    scran_tests::expect_error([&]() { scran_tests::parse_scale_factor("-1", 1); }, "positive number");
+
+    EXPECT_GT(scran_tests::scale_factor(), 0);
+    EXPECT_EQ(scran_tests::is_scaled_up(), scran_tests::scale_factor() > 1);
+}
+
+TEST(Scale, Extent) {
+    EXPECT_EQ(scran_tests::scale_extent(100, 1), 100);
+    EXPECT_EQ(scran_tests::scale_extent(100, 10), 1000);
+    EXPECT_EQ(scran_tests::scale_extent(100, 0.5), 50);
+    EXPECT_EQ(scran_tests::scale_extent(100, 0.001), 1);
+    EXPECT_EQ(scran_tests::scale_extent(0, 10), 0);
+    EXPECT_EQ(scran_tests::scale_extent<std::size_t>(10, 2.5), 25);
+
+    EXPECT_EQ(scran_tests::scale_extent<std::uint8_t>(100, 2.5), 250);
+    scran_tests::expect_error([&]() { scran_tests::scale_extent<std::uint8_t>(100, 3); }, "does not fit");
+    EXPECT_EQ(scran_tests::scale_extent<std::uint8_t>(85, 3), 255);
+    scran_tests::expect_error([&]() { scran_tests::scale_extent<std::uint64_t>(1ull << 63, 2); }, "does not fit");
+
+    constexpr auto nan = std::numeric_limits<double>::quiet_NaN();
+    scran_tests::expect_error([&]() { scran_tests::scale_extent(100, nan); }, "positive number");
+    scran_tests::expect_error([&]() { scran_tests::scale_extent(100, 0.0); }, "positive number");
+    scran_tests::expect_error([&]() { scran_tests::scale_extent(100, -1.0); }, "positive number");
+}
+
+TEST(Scale, Simulate) {
+    {
+        scran_tests::SimulateVectorParameters params;
+        auto res = scran_tests::simulate_scaled_vector(100, params);
+        EXPECT_EQ(res.size(), scran_tests::scale_extent(100));
+        EXPECT_EQ(res, scran_tests::simulate_vector(res.size(), params));
+    }
+
+    {
+        scran_tests::SimulateCompressedSparseMatrixParameters params;
+        auto res = scran_tests::simulate_scaled_compressed_sparse_matrix(10, 20, params);
+        EXPECT_EQ(res.primary, scran_tests::scale_extent(10));
+        EXPECT_EQ(res.secondary, scran_tests::scale_extent(20));
+
+        auto ref = scran_tests::simulate_compressed_sparse_matrix(res.primary, res.secondary, params);
+        EXPECT_EQ(res.pointers, ref.pointers);
+        EXPECT_EQ(res.index, ref.index);
+        EXPECT_EQ(res.data, ref.data);
+    }
+}
+
+TEST(Scale, Timer) {
+    scran_tests::ScaleTimer timer("foo");
+    EXPECT_GE(timer.elapsed(), 0);
+
+#if defined(__unix__) || defined(__APPLE__)
+    EXPECT_GT(scran_tests::peak_memory_usage(), 0);
+
+    // Touching every page of a large allocation should raise the peak.
+    std::vector<char> big(64 * 1024 * 1024, 1);
+    EXPECT_EQ(big.back(), 1);
+    EXPECT_GT(timer.peak_memory_increase(), 0);
+#else
+    EXPECT_EQ(scran_tests::peak_memory_usage(), 0);
+    EXPECT_EQ(timer.peak_memory_increase(), 0);
+#endif
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "scran_tests/simulate_compressed_sparse_chunks.hpp"
+#include "scran_tests/expect_error.hpp"
+
+template<typename Data_, typename Index_, typename Pointer_>
+void check_concatenated(Index_ primary, Index_ secondary, Index_ chunk_size, const scran_tests::SimulateCompressedSparseMatrixParameters<Data_>& params) {
+    auto ref = scran_tests::simulate_compressed_sparse_matrix<Data_, Index_, Pointer_>(primary, secondary, params);
+
+    scran_tests::CompressedSparseChunkSimulator<Data_, Index_, Pointer_> sim(primary, secondary, chunk_size, params);
+    EXPECT_EQ(sim.primary(), primary);
+    EXPECT_EQ(sim.secondary(), secondary);
+
+    std::vector<Data_> data;
+    std::vector<Index_> index;
+    std::vector<Pointer_> pointers{ 0 };
+    Index_ expected_start = 0;
+
+    while (auto chunk = sim.next()) {
+        EXPECT_EQ(chunk->start, expected_start);
+        EXPECT_GT(chunk->length, 0);
+        EXPECT_LE(chunk->length, chunk_size);
+        EXPECT_EQ(chunk->secondary, secondary);
+        EXPECT_EQ(chunk->pointers.size(), static_cast<std::size_t>(chunk->length) + 1);
+        EXPECT_EQ(chunk->pointers.front(), 0);
+        EXPECT_EQ(chunk->pointers.back(), chunk->index.size());
+        EXPECT_EQ(chunk->pointers.back(), chunk->data.size());
+
+        const auto offset = pointers.back();
+        for (Index_ p = 0; p < chunk->length; ++p) {
+            pointers.push_back(offset + chunk->pointers[p + 1]);
+        }
+        data.insert(data.end(), chunk->data.begin(), chunk->data.end());
+        index.insert(index.end(), chunk->index.begin(), chunk->index.end());
+        expected_start += chunk->length;
+    }
+
+    EXPECT_EQ(expected_start, primary);
+    EXPECT_EQ(sim.next(), nullptr);
+    EXPECT_EQ(data, ref.data);
+    EXPECT_EQ(index, ref.index);
+    EXPECT_EQ(pointers, ref.pointers);
+}
+
+TEST(SimulateCompressedSparseChunks, Concatenation) {
+    scran_tests::SimulateCompressedSparseMatrixParameters params;
+    check_concatenated<double, int, std::size_t>(100, 50, 7, params); // uneven last chunk.
+    check_concatenated<double, int, std::size_t>(100, 50, 10, params); // even chunks.
+    check_concatenated<double, int, std::size_t>(100, 50, 1, params);
+    check_concatenated<double, int, std::size_t>(100, 50, 1000, params); // single chunk.
+
+    params.seed = 42;
+    params.density = 0.5;
+    check_concatenated<double, int, std::size_t>(33, 21, 5, params);
+}
+
+TEST(SimulateCompressedSparseChunks, Types) {
+    scran_tests::SimulateCompressedSparseMatrixParameters<std::uint8_t> params;
+    check_concatenated<std::uint8_t, std::uint16_t, std::uint32_t>(60, 40, 9, params);
+}
+
+TEST(SimulateCompressedSparseChunks, Empty) {
+    scran_tests::SimulateCompressedSparseMatrixParameters params;
+    scran_tests::CompressedSparseChunkSimulator<> sim(0, 10, 5, params);
+    EXPECT_EQ(sim.next(), nullptr);
+
+    // Early destruction without consuming all chunks is fine.
+    scran_tests::CompressedSparseChunkSimulator<> sim2(100, 10, 5, params);
+    EXPECT_NE(sim2.next(), nullptr);
+
+    scran_tests::expect_error([&]() { scran_tests::CompressedSparseChunkSimulator<> sim(10, 10, 0, params); }, "positive");
+    scran_tests::expect_error([&]() { scran_tests::CompressedSparseChunkSimulator<> sim(-1, 10, 5, params); }, "non-negative");
+    scran_tests::expect_error([&]() { scran_tests::CompressedSparseChunkSimulator<> sim(10, -1, 5, params); }, "non-negative");
+}
+
+TEST(SimulateCompressedSparseChunks, PointerOverflow) {
+    scran_tests::SimulateCompressedSparseMatrixParameters params;
+    params.density = 1;
+
+    // Pointers are local to each chunk, so only the chunk size matters.
+    scran_tests::CompressedSparseChunkSimulator<double, int, std::uint8_t> ok(100, 50, 5, params);
+    while (ok.next()) {}
+
+    scran_tests::CompressedSparseChunkSimulator<double, int, std::uint8_t> sim(100, 50, 10, params);
+    scran_tests::expect_error([&]() { sim.next(); }, "overflows the pointer type");
+
+    // Subsequent calls continue to fail rather than signalling the end of the stream.
+    scran_tests::expect_error([&]() { sim.next(); }, "overflows the pointer type");
+    scran_tests::expect_error([&]() { sim.next(); }, "overflows the pointer type");
+}
@@ -2,8 +2,11 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <type_traits>
+#include <vector>
 
 #include "scran_tests/simulate_compressed_sparse_matrix.hpp"
+#include "scran_tests/expect_error.hpp"
 
 TEST(SimulateCompressedSparseMatrix, Basic) {
     {
@@ -88,3 +91,35 @@ TEST(SimulateCompressedSparseMatrix, Unsigned) {
     std::sort(res.data.begin(), res.data.end());
     EXPECT_NE(res.data.front(), res.data.back());
 }
+
+TEST(SimulateCompressedSparseMatrix, PointerOverflow) {
+    scran_tests::SimulateCompressedSparseMatrixParameters params;
+    params.density = 1;
+
+    // Exactly at the limit is fine.
+    auto res = scran_tests::simulate_compressed_sparse_matrix<double, int, std::uint8_t>(15, 17, params);
+    EXPECT_EQ(res.pointers.back(), 255);
+
+    scran_tests::expect_error([&]() {
+        scran_tests::simulate_compressed_sparse_matrix<double, int, std::uint8_t>(16, 16, params);
+    }, "overflows the pointer type");
+
+    scran_tests::expect_error([&]() {
+        scran_tests::simulate_compressed_sparse_matrix<double, int, std::int8_t>(16, 8, params);
+    }, "overflows the pointer type");
+}
+
+TEST(SimulateCompressedSparseMatrix, Extents) {
+    scran_tests::SimulateCompressedSparseMatrixParameters params;
+    params.density = 0.01;
+
+    // Index type is deduced from the extents.
+    std::uint16_t nr = 10, nc = 65535;
+    auto res = scran_tests::simulate_compressed_sparse_matrix(nr, nc, params);
+    EXPECT_TRUE((std::is_same<decltype(res.index), std::vector<std::uint16_t> >::value));
+    EXPECT_EQ(res.secondary, 65535);
+    EXPECT_EQ(res.pointers.size(), 11);
+
+    scran_tests::expect_error([&]() { scran_tests::simulate_compressed_sparse_matrix(-1, 10, params); }, "non-negative");
+    scran_tests::expect_error([&]() { scran_tests::simulate_compressed_sparse_matrix(10, -1, params); }, "non-negative");
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+#include "scran_tests/type_limit_fixtures.hpp"
+#include "scran_tests/expect_error.hpp"
+
+TEST(TypeLimitFixtures, IndexLimit) {
+    scran_tests::SimulateCompressedSparseMatrixParameters params;
+    params.density = 0.001;
+
+    auto res = scran_tests::simulate_compressed_sparse_matrix_at_index_limit<double, std::uint16_t, std::uint32_t>(10, params);
+    EXPECT_EQ(res.primary, 10);
+    EXPECT_EQ(res.secondary, std::numeric_limits<std::uint16_t>::max());
+    EXPECT_EQ(res.pointers.size(), 11);
+    EXPECT_EQ(res.pointers.back(), res.index.size());
+    EXPECT_EQ(res.pointers.back(), res.data.size());
+
+    for (int p = 0; p < 10; ++p) {
+        const auto start = res.pointers[p], end = res.pointers[p + 1];
+        ASSERT_LT(start, end);
+        EXPECT_TRUE(std::is_sorted(res.index.begin() + start, res.index.begin() + end));
+        EXPECT_EQ(res.index[end - 1], 65534);
+        EXPECT_NE(res.data[end - 1], 0);
+    }
+
+    // Also works for tiny types where the primary extent is also at the limit.
+    auto tiny = scran_tests::simulate_compressed_sparse_matrix_at_index_limit<std::uint8_t, std::uint8_t, std::uint16_t>(255, {});
+    EXPECT_EQ(tiny.secondary, 255);
+    EXPECT_EQ(tiny.pointers.size(), 256);
+    for (int p = 0; p < 255; ++p) {
+        EXPECT_EQ(tiny.index[tiny.pointers[p + 1] - 1], 254);
+    }
+}
+
+TEST(TypeLimitFixtures, IndexLimitValues) {
+    // Forced entries are non-zero even if the simulated value is zero.
+    scran_tests::SimulateCompressedSparseMatrixParameters<int> params;
+    params.density = 0;
+    params.lower = -1;
+    params.upper = 1;
+    for (int seed = 0; seed < 10; ++seed) {
+        params.seed = seed;
+        auto res = scran_tests::simulate_compressed_sparse_matrix_at_index_limit<int, std::uint8_t>(5, params);
+        ASSERT_EQ(res.data.size(), 5);
+        for (auto x : res.data) {
+            EXPECT_NE(x, 0);
+        }
+    }
+
+    params.lower = 0;
+    scran_tests::expect_error([&]() {
+        scran_tests::simulate_compressed_sparse_matrix_at_index_limit<int, std::uint8_t>(5, params);
+    }, "non-zero value");
+
+    scran_tests::expect_error([&]() {
+        scran_tests::simulate_compressed_sparse_matrix_at_index_limit<double, std::int8_t>(-1, {});
+    }, "non-negative");
+}
+
+TEST(TypeLimitFixtures, FirstOverflowingNnz) {
+    EXPECT_EQ(scran_tests::first_overflowing_nnz<std::uint8_t>(), 256);
+    EXPECT_EQ(scran_tests::first_overflowing_nnz<std::uint16_t>(), 65536);
+    EXPECT_EQ(scran_tests::first_overflowing_nnz<std::int32_t>(), 2147483648ull);
+    EXPECT_EQ(scran_tests::first_overflowing_nnz<std::uint32_t>(), 4294967296ull);
+}
+
+TEST(TypeLimitFixtures, Pointers) {
+    auto ptrs = scran_tests::simulate_compressed_sparse_pointers<std::uint16_t>(4, 10, 10);
+    std::vector<std::uint16_t> expected{ 0, 3, 6, 8, 10 };
+    EXPECT_EQ(ptrs, expected);
+
+    auto full = scran_tests::simulate_compressed_sparse_pointers<int>(3, 5, 15);
+    EXPECT_EQ(full.back(), 15);
+    auto empty = scran_tests::simulate_compressed_sparse_pointers<int>(0, 5, 0);
+    EXPECT_EQ(empty, std::vector<int>{ 0 });
+
+    scran_tests::expect_error([&]() { scran_tests::simulate_compressed_sparse_pointers<int>(3, 5, 16); }, "exceeds the number of cells");
+    scran_tests::expect_error([&]() { scran_tests::simulate_compressed_sparse_pointers<int>(0, 5, 1); }, "exceeds the number of cells");
+    scran_tests::expect_error([&]() { scran_tests::simulate_compressed_sparse_pointers<std::uint8_t>(2, 200, 256); }, "overflows the pointer type");
+    scran_tests::expect_error([&]() { scran_tests::simulate_compressed_sparse_pointers<int>(-1, 5, 0); }, "non-negative");
+    scran_tests::expect_error([&]() { scran_tests::simulate_compressed_sparse_pointers<int>(3, -1, 0); }, "non-negative");
+}
+
+TEST(TypeLimitFixtures, Over32Bits) {
+    const auto nnz = scran_tests::first_overflowing_nnz<std::uint32_t>() + 1;
+
+    auto ptrs = scran_tests::simulate_compressed_sparse_pointers<std::uint64_t>(100000, 100000, nnz);
+    EXPECT_EQ(ptrs.size(), 100001);
+    EXPECT_EQ(ptrs.back(), nnz);
+    EXPECT_TRUE(std::is_sorted(ptrs.begin(), ptrs.end()));
+    EXPECT_GT(ptrs.back(), std::numeric_limits<std::uint32_t>::max());
+
+    scran_tests::expect_error([&]() {
+        scran_tests::simulate_compressed_sparse_pointers<std::uint32_t>(100000, 100000, nnz);
+    }, "overflows the pointer type");
+
+    // Exactly at the limit is fine for 32-bit pointers.
+    auto limit = scran_tests::simulate_compressed_sparse_pointers<std::uint32_t>(100000, 100000, nnz - 2);
+    EXPECT_EQ(limit.back(), std::numeric_limits<std::uint32_t>::max());
+}